@@ -233,7 +233,6 @@ int main(int argc, char* argv[]) {
     strcpy(dotdot_entry.name, "..");
     
 
-    superblock_crc_finalize(&sb);
     inode_crc_finalize(&root_inode);
     dirent_checksum_finalize(&dot_entry);
     dirent_checksum_finalize(&dotdot_entry);
@@ -248,6 +247,8 @@ int main(int argc, char* argv[]) {
 
     uint8_t block_buffer[BS] = {0};
     memcpy(block_buffer, &sb, sizeof(superblock_t));
+    // the crc covers the whole zero-padded block, not just the struct
+    superblock_crc_finalize((superblock_t*)block_buffer);
     fwrite(block_buffer, 1, BS, fp);
     
 
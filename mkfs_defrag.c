@@ -0,0 +1,388 @@
+// Build: gcc -O2 -std=c17 -Wall -Wextra mkfs_defrag.c -o mkfs_defrag
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <inttypes.h>
+
+#include "mkfs_reader.h"
+
+// ==========================DO NOT CHANGE THIS PORTION=========================
+// These functions are there for your help. You should refer to the specifications to see how you can use them.
+// ====================================CRC32====================================
+uint32_t CRC32_TAB[256];
+void crc32_init(void){
+    for (uint32_t i=0;i<256;i++){
+        uint32_t c=i;
+        for(int j=0;j<8;j++) c = (c&1)?(0xEDB88320u^(c>>1)):(c>>1);
+        CRC32_TAB[i]=c;
+    }
+}
+uint32_t crc32(const void* data, size_t n){
+    const uint8_t* p=(const uint8_t*)data; uint32_t c=0xFFFFFFFFu;
+    for(size_t i=0;i<n;i++) c = CRC32_TAB[(c^p[i])&0xFF] ^ (c>>8);
+    return c ^ 0xFFFFFFFFu;
+}
+// ====================================CRC32====================================
+
+// WARNING: CALL THIS ONLY AFTER ALL OTHER SUPERBLOCK ELEMENTS HAVE BEEN FINALIZED
+static uint32_t superblock_crc_finalize(superblock_t *sb) {
+    sb->checksum = 0;
+    uint32_t s = crc32((void *) sb, BS - 4);
+    sb->checksum = s;
+    return s;
+}
+
+// WARNING: CALL THIS ONLY AFTER ALL OTHER SUPERBLOCK ELEMENTS HAVE BEEN FINALIZED
+void inode_crc_finalize(inode_t* ino){
+    uint8_t tmp[INODE_SIZE]; memcpy(tmp, ino, INODE_SIZE);
+    // zero crc area before computing
+    memset(&tmp[120], 0, 8);
+    uint32_t c = crc32(tmp, 120);
+    ino->inode_crc = (uint64_t)c;
+}
+
+// WARNING: CALL THIS ONLY AFTER ALL OTHER SUPERBLOCK ELEMENTS HAVE BEEN FINALIZED
+void dirent_checksum_finalize(dirent64_t* de) {
+    const uint8_t* p = (const uint8_t*)de;
+    uint8_t x = 0;
+    for (int i = 0; i < 63; i++) x ^= p[i];
+    de->checksum = x;
+}
+
+int inode_is_live(const uint8_t* inode_bitmap, uint64_t ino) {
+    return (inode_bitmap[(ino - 1) / 8] & (1 << ((ino - 1) % 8))) != 0;
+}
+
+int superblock_crc_ok(const uint8_t* block) {
+    uint8_t tmp[BS];
+    memcpy(tmp, block, BS);
+    superblock_t* sb = (superblock_t*)tmp;
+    uint32_t stored = sb->checksum;
+    return superblock_crc_finalize(sb) == stored;
+}
+
+int inode_crc_ok(const inode_t* ino) {
+    inode_t tmp = *ino;
+    inode_crc_finalize(&tmp);
+    return tmp.inode_crc == ino->inode_crc;
+}
+
+int dirent_checksum_ok(const dirent64_t* de) {
+    dirent64_t tmp = *de;
+    dirent_checksum_finalize(&tmp);
+    return tmp.checksum == de->checksum;
+}
+
+void print_usage(const char* prog_name) {
+    printf("Usage: %s --input <input.img> --output <output.img> [--truncate]\n", prog_name);
+}
+
+int parse_args(int argc, char* argv[], char** input_name, char** output_name, int* truncate) {
+    if (argc != 5 && argc != 6) {
+        return -1;
+    }
+
+    *input_name = NULL;
+    *output_name = NULL;
+    *truncate = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--truncate") == 0) {
+            *truncate = 1;
+        } else if (i + 1 < argc && strcmp(argv[i], "--input") == 0) {
+            *input_name = argv[++i];
+        } else if (i + 1 < argc && strcmp(argv[i], "--output") == 0) {
+            *output_name = argv[++i];
+        } else {
+            return -1;
+        }
+    }
+
+    if (*input_name == NULL || *output_name == NULL) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    crc32_init();
+
+
+    char* input_name;
+    char* output_name;
+    int truncate;
+
+    if (parse_args(argc, argv, &input_name, &output_name, &truncate) != 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    printf("Defragmenting filesystem\n");
+    printf("Input: %s, Output: %s\n", input_name, output_name);
+
+
+    FILE* input_fp = fopen(input_name, "rb");
+    if (!input_fp) {
+        fprintf(stderr, "Error: Cannot open input image %s\n", input_name);
+        return 1;
+    }
+
+    fseeko(input_fp, 0, SEEK_END);
+    off_t fs_size = ftello(input_fp);
+    fseeko(input_fp, 0, SEEK_SET);
+
+    if (fs_size < (off_t)BS) {
+        fprintf(stderr, "Error: Cannot read superblock\n");
+        fclose(input_fp);
+        return 1;
+    }
+
+    uint8_t* fs_data = malloc(fs_size);
+    if (!fs_data) {
+        fprintf(stderr, "Error: Cannot allocate memory\n");
+        fclose(input_fp);
+        return 1;
+    }
+
+    if (fread(fs_data, 1, fs_size, input_fp) != (size_t)fs_size) {
+        fprintf(stderr, "Error: Cannot read filesystem data\n");
+        fclose(input_fp);
+        free(fs_data);
+        return 1;
+    }
+    fclose(input_fp);
+
+
+    superblock_t* sb = (superblock_t*)fs_data;
+    if (sb->magic != 0x4D565346) {
+        fprintf(stderr, "Error: Invalid filesystem magic number\n");
+        free(fs_data);
+        return 1;
+    }
+
+    if (!superblock_crc_ok(fs_data)) {
+        fprintf(stderr, "Error: Superblock checksum mismatch\n");
+        free(fs_data);
+        return 1;
+    }
+
+    if (!fs_layout_valid(sb, fs_size)) {
+        fprintf(stderr, "Error: Superblock layout does not fit the image\n");
+        free(fs_data);
+        return 1;
+    }
+
+
+    uint8_t* inode_bitmap = fs_data + sb->inode_bitmap_start * BS;
+    uint8_t* data_bitmap = fs_data + sb->data_bitmap_start * BS;
+    inode_t* inode_table = (inode_t*)(fs_data + sb->inode_table_start * BS);
+    uint8_t* data_region = fs_data + sb->data_region_start * BS;
+    inode_t* root_inode = &inode_table[ROOT_INO - 1];
+
+    // Every checksum is rewritten below, so refuse to launder existing
+    // corruption into a clean-looking image.
+    if (!inode_is_live(inode_bitmap, ROOT_INO)) {
+        fprintf(stderr, "Error: Root directory inode is not allocated\n");
+        free(fs_data);
+        return 1;
+    }
+    for (uint64_t ino = 1; ino <= sb->inode_count; ino++) {
+        if (inode_is_live(inode_bitmap, ino) && !inode_crc_ok(&inode_table[ino - 1])) {
+            fprintf(stderr, "Error: Inode %" PRIu64 " checksum mismatch\n", ino);
+            free(fs_data);
+            return 1;
+        }
+    }
+
+    int root_blocks = (root_inode->size_bytes + BS - 1) / BS;
+    if (root_blocks < 1 || root_blocks > DIRECT_MAX) {
+        fprintf(stderr, "Error: Root directory inode is corrupt\n");
+        free(fs_data);
+        return 1;
+    }
+    for (int b = 0; b < root_blocks; b++) {
+        if (!fs_block_valid(sb, root_inode->direct[b])) {
+            fprintf(stderr, "Error: Root directory inode is corrupt\n");
+            free(fs_data);
+            return 1;
+        }
+    }
+
+
+    // Pack the live root entries into the leading slots, keeping their order.
+    int per_block = BS / sizeof(dirent64_t);
+    int max_dirents = root_blocks * per_block;
+    dirent64_t* live_dirents = calloc(max_dirents, sizeof(dirent64_t));
+    if (!live_dirents) {
+        fprintf(stderr, "Error: Cannot allocate memory\n");
+        free(fs_data);
+        return 1;
+    }
+
+    int live_count = 0;
+    int slots_moved = 0;
+    for (int i = 0; i < max_dirents; i++) {
+        uint64_t block_offset = (root_inode->direct[i / per_block] - sb->data_region_start) * BS;
+        dirent64_t* de = (dirent64_t*)(data_region + block_offset) + i % per_block;
+        if (de->inode_no != 0) {
+            if (!dirent_checksum_ok(de) || de->inode_no > sb->inode_count ||
+                !inode_is_live(inode_bitmap, de->inode_no)) {
+                fprintf(stderr, "Error: Directory entry %d is corrupt or points at a free inode\n", i);
+                free(live_dirents);
+                free(fs_data);
+                return 1;
+            }
+            if (i != live_count) {
+                slots_moved++;
+            }
+            live_dirents[live_count++] = *de;
+        }
+    }
+
+
+    // Relocation order: the root directory, then files in directory order,
+    // then any live inode no entry points at. Each file lands on the next
+    // free block so every file ends up contiguous and the region is packed.
+    uint32_t* order = malloc((sb->inode_count + 1) * sizeof(uint32_t));
+    uint8_t* queued = calloc(sb->inode_count + 1, 1);
+    uint8_t* claimed = calloc(sb->data_region_blocks, 1);
+    uint8_t* new_region = calloc(sb->data_region_blocks, BS);
+    if (!order || !queued || !claimed || !new_region) {
+        fprintf(stderr, "Error: Cannot allocate memory\n");
+        free(order); free(queued); free(claimed); free(new_region);
+        free(live_dirents);
+        free(fs_data);
+        return 1;
+    }
+
+    int order_count = 0;
+    order[order_count++] = ROOT_INO;
+    queued[ROOT_INO] = 1;
+    for (int i = 0; i < live_count; i++) {
+        uint32_t ino = live_dirents[i].inode_no;
+        if (!queued[ino]) {
+            order[order_count++] = ino;
+            queued[ino] = 1;
+        }
+    }
+    for (uint64_t ino = 1; ino <= sb->inode_count; ino++) {
+        if (!queued[ino] && inode_is_live(inode_bitmap, ino)) {
+            order[order_count++] = ino;
+            queued[ino] = 1;
+        }
+    }
+
+    uint64_t next_block = 0;
+    int blocks_moved = 0;
+    int files_fragmented = 0;
+    int error = 0;
+    for (int n = 0; n < order_count && !error; n++) {
+        inode_t* ino = &inode_table[order[n] - 1];
+        if (ino->size_bytes > (uint64_t)DIRECT_MAX * BS) {
+            fprintf(stderr, "Error: Inode %u is corrupt\n", order[n]);
+            error = 1;
+            break;
+        }
+
+        int blocks_used = (ino->size_bytes + BS - 1) / BS;
+        for (int i = 1; i < blocks_used; i++) {
+            if (ino->direct[i] != ino->direct[i - 1] + 1) {
+                files_fragmented++;
+                break;
+            }
+        }
+
+        for (int i = 0; i < blocks_used; i++) {
+            uint64_t old_idx = ino->direct[i] - sb->data_region_start;
+            if (!fs_block_valid(sb, ino->direct[i]) || claimed[old_idx]) {
+                fprintf(stderr, "Error: Inode %u has an invalid or shared block\n", order[n]);
+                error = 1;
+                break;
+            }
+            claimed[old_idx] = 1;
+
+            memcpy(new_region + next_block * BS, data_region + old_idx * BS, BS);
+            if (old_idx != next_block) {
+                blocks_moved++;
+            }
+            ino->direct[i] = sb->data_region_start + next_block;
+            next_block++;
+        }
+        for (int i = blocks_used; i < DIRECT_MAX; i++) {
+            ino->direct[i] = 0;
+        }
+
+        inode_crc_finalize(ino);
+    }
+
+    if (error) {
+        free(order); free(queued); free(claimed); free(new_region);
+        free(live_dirents);
+        free(fs_data);
+        return 1;
+    }
+
+    // Rewrite the root directory from the packed entries, now that its
+    // blocks have moved with the rest of the region.
+    for (int b = 0; b < root_blocks; b++) {
+        uint64_t block_offset = (root_inode->direct[b] - sb->data_region_start) * BS;
+        memset(new_region + block_offset, 0, BS);
+    }
+    for (int i = 0; i < live_count; i++) {
+        uint64_t block_offset = (root_inode->direct[i / per_block] - sb->data_region_start) * BS;
+        dirent64_t* de = (dirent64_t*)(new_region + block_offset) + i % per_block;
+        *de = live_dirents[i];
+    }
+
+    memcpy(data_region, new_region, sb->data_region_blocks * BS);
+
+    memset(data_bitmap, 0, sb->data_bitmap_blocks * BS);
+    for (uint64_t b = 0; b < next_block; b++) {
+        data_bitmap[b / 8] |= (1 << (b % 8));
+    }
+
+    free(order); free(queued); free(claimed); free(new_region);
+    free(live_dirents);
+
+
+    uint64_t out_size = fs_size;
+    if (truncate) {
+        sb->data_region_blocks = next_block;
+        sb->total_blocks = sb->data_region_start + next_block;
+        out_size = sb->total_blocks * BS;
+    }
+    superblock_crc_finalize(sb);
+
+    printf("Defragmented %d fragmented file(s), relocated %d block(s)\n", files_fragmented, blocks_moved);
+    printf("Compacted %d directory entr%s, data high-water mark: block %" PRIu64 "\n",
+           slots_moved, slots_moved == 1 ? "y" : "ies", sb->data_region_start + next_block);
+
+
+    FILE* output_fp = fopen(output_name, "wb");
+    if (!output_fp) {
+        fprintf(stderr, "Error: Cannot create output file %s\n", output_name);
+        free(fs_data);
+        return 1;
+    }
+
+    if (fwrite(fs_data, 1, out_size, output_fp) != (size_t)out_size) {
+        fprintf(stderr, "Error: Cannot write output file %s\n", output_name);
+        fclose(output_fp);
+        free(fs_data);
+        return 1;
+    }
+    fclose(output_fp);
+
+    free(fs_data);
+
+    if (truncate) {
+        printf("Image truncated to %" PRIu64 " bytes\n", out_size);
+    }
+    printf("Filesystem defragmented successfully!\n");
+    return 0;
+}
@@ -0,0 +1,289 @@
+// Build: gcc -O2 -std=c17 -Wall -Wextra -pthread mkfs_extract.c -o mkfs_extract
+#define _GNU_SOURCE
+#define _FILE_OFFSET_BITS 64
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "mkfs_reader.h"
+
+// Hints the kernel to start paging in every run of the view.
+void fs_readahead(const fs_image_t* img, const fs_view_t* view) {
+    uintptr_t page = sysconf(_SC_PAGESIZE);
+    for (int i = 0; i < view->iovcnt; i++) {
+        uintptr_t start = (uintptr_t)view->iov[i].iov_base;
+        uintptr_t aligned = start & ~(page - 1);
+        madvise((void*)aligned, start + view->iov[i].iov_len - aligned, MADV_WILLNEED);
+        posix_fadvise(img->fd, (off_t)((uint8_t*)view->iov[i].iov_base - img->base),
+                      view->iov[i].iov_len, POSIX_FADV_WILLNEED);
+    }
+}
+
+// Copies the view into out_fd in the kernel where possible, falling back to
+// writing straight out of the mapping.
+int fs_copy_view(const fs_image_t* img, const fs_view_t* view, int out_fd) {
+    loff_t out_off = 0;
+    for (int i = 0; i < view->iovcnt; i++) {
+        loff_t in_off = (uint8_t*)view->iov[i].iov_base - img->base;
+        size_t left = view->iov[i].iov_len;
+        while (left > 0) {
+            ssize_t n = copy_file_range(img->fd, &in_off, out_fd, &out_off, left, 0);
+            if (n < 0 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL ||
+                          errno == EOPNOTSUPP)) {
+                n = pwrite(out_fd, img->base + in_off, left, out_off);
+                if (n > 0) {
+                    in_off += n;
+                    out_off += n;
+                }
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                return -1;
+            }
+            left -= n;
+        }
+    }
+    return 0;
+}
+
+typedef struct {
+    uint32_t inode_no;
+    char buf[58];                 // NUL-terminated copy of the entry name
+    const char* out_name;         // final path component of buf
+} extract_job_t;
+
+typedef struct {
+    const fs_image_t* img;
+    int out_dir;
+    extract_job_t* jobs;
+    int job_count;
+    atomic_int next;
+    atomic_int failed;
+} extract_ctx_t;
+
+// Dirent names may carry the host path they were added from; only the final
+// component is used so extraction cannot escape the output directory.
+const char* output_name(const char* name, char* buf) {
+    strncpy(buf, name, 57);
+    buf[57] = '\0';
+    const char* base = strrchr(buf, '/');
+    base = base ? base + 1 : buf;
+    if (base[0] == '\0' || strcmp(base, ".") == 0 || strcmp(base, "..") == 0) {
+        return NULL;
+    }
+    return base;
+}
+
+// Queues an entry, rejecting names that are unusable or that collide with an
+// earlier entry once reduced to their final component.
+int add_job(extract_job_t* jobs, int* job_count, uint32_t inode_no, const char* name) {
+    extract_job_t* job = &jobs[*job_count];
+    job->inode_no = inode_no;
+    job->out_name = output_name(name, job->buf);
+    if (!job->out_name) {
+        fprintf(stderr, "Error: Cannot extract entry with unusable name '%s'\n", job->buf);
+        return -1;
+    }
+    for (int i = 0; i < *job_count; i++) {
+        if (strcmp(jobs[i].out_name, job->out_name) == 0) {
+            fprintf(stderr, "Error: Entries '%s' and '%s' both extract to %s\n",
+                    jobs[i].buf, job->buf, job->out_name);
+            return -1;
+        }
+    }
+    (*job_count)++;
+    return 0;
+}
+
+int extract_one(const extract_ctx_t* ctx, const extract_job_t* job) {
+    const char* name = job->out_name;
+    const inode_t* ino = fs_get_inode(ctx->img, job->inode_no);
+    fs_view_t view;
+    if (!ino || (ino->mode & 0170000) != 0100000 || fs_file_view(ctx->img, ino, &view) != 0) {
+        fprintf(stderr, "Error: Inode %u for %s is corrupt\n", job->inode_no, name);
+        return -1;
+    }
+
+    int out_fd = openat(ctx->out_dir, name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0) {
+        fprintf(stderr, "Error: Cannot create output file %s\n", name);
+        return -1;
+    }
+    if (fs_copy_view(ctx->img, &view, out_fd) != 0) {
+        fprintf(stderr, "Error: Cannot write output file %s\n", name);
+        close(out_fd);
+        return -1;
+    }
+    close(out_fd);
+
+    printf("Extracted %s (%" PRIu64 " bytes, %d extent%s)\n", name, view.size,
+           view.iovcnt, view.iovcnt == 1 ? "" : "s");
+    return 0;
+}
+
+void* extract_worker(void* arg) {
+    extract_ctx_t* ctx = arg;
+    for (;;) {
+        int i = atomic_fetch_add(&ctx->next, 1);
+        if (i >= ctx->job_count) {
+            break;
+        }
+        if (extract_one(ctx, &ctx->jobs[i]) != 0) {
+            atomic_fetch_add(&ctx->failed, 1);
+        }
+    }
+    return NULL;
+}
+
+void print_usage(const char* prog_name) {
+    printf("Usage: %s --input <image.img> --output-dir <dir> [--file <filename>] [--jobs <n>]\n", prog_name);
+}
+
+int parse_args(int argc, char* argv[], char** input_name, char** output_dir, char** file_name, int* jobs) {
+    if (argc < 5 || argc > 9 || argc % 2 != 1) {
+        return -1;
+    }
+
+    *input_name = NULL;
+    *output_dir = NULL;
+    *file_name = NULL;
+    *jobs = 0;
+
+    for (int i = 1; i < argc; i += 2) {
+        if (strcmp(argv[i], "--input") == 0) {
+            *input_name = argv[i + 1];
+        } else if (strcmp(argv[i], "--output-dir") == 0) {
+            *output_dir = argv[i + 1];
+        } else if (strcmp(argv[i], "--file") == 0) {
+            *file_name = argv[i + 1];
+        } else if (strcmp(argv[i], "--jobs") == 0) {
+            *jobs = atoi(argv[i + 1]);
+            if (*jobs < 1) {
+                return -1;
+            }
+        } else {
+            return -1;
+        }
+    }
+
+    if (*input_name == NULL || *output_dir == NULL) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    char* input_name;
+    char* output_dir;
+    char* file_name;
+    int jobs;
+
+    if (parse_args(argc, argv, &input_name, &output_dir, &file_name, &jobs) != 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    fs_image_t img;
+    if (fs_image_open(input_name, &img) != 0) {
+        return 1;
+    }
+
+    int out_dir = open(output_dir, O_RDONLY | O_DIRECTORY);
+    if (out_dir < 0) {
+        fprintf(stderr, "Error: Cannot open output directory %s\n", output_dir);
+        fs_image_close(&img);
+        return 1;
+    }
+
+    extract_job_t job_list[BS / sizeof(dirent64_t) * DIRECT_MAX];
+    int job_count = 0;
+    if (file_name) {
+        int ino = fs_lookup(&img, file_name);
+        if (ino == -1) {
+            fprintf(stderr, "Error: File %s not found in image\n", file_name);
+            close(out_dir);
+            fs_image_close(&img);
+            return 1;
+        }
+        if (add_job(job_list, &job_count, ino, file_name) != 0) {
+            close(out_dir);
+            fs_image_close(&img);
+            return 1;
+        }
+    } else {
+        int cursor = 0;
+        const dirent64_t* de;
+        while (fs_next_dirent(&img, &cursor, &de) == 0) {
+            if (de->type != 1) {
+                continue;
+            }
+            if (add_job(job_list, &job_count, de->inode_no, de->name) != 0) {
+                close(out_dir);
+                fs_image_close(&img);
+                return 1;
+            }
+        }
+    }
+
+    // Queue readahead for everything up front so the workers find it resident.
+    for (int i = 0; i < job_count; i++) {
+        const inode_t* ino = fs_get_inode(&img, job_list[i].inode_no);
+        fs_view_t view;
+        if (ino && fs_file_view(&img, ino, &view) == 0) {
+            fs_readahead(&img, &view);
+        }
+    }
+
+    if (jobs == 0) {
+        jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (jobs > job_count) {
+        jobs = job_count;
+    }
+    if (jobs < 1) {
+        jobs = 1;
+    }
+
+    extract_ctx_t ctx = { .img = &img, .out_dir = out_dir, .jobs = job_list, .job_count = job_count };
+    atomic_init(&ctx.next, 0);
+    atomic_init(&ctx.failed, 0);
+
+    pthread_t threads[64];
+    if (jobs > 64) {
+        jobs = 64;
+    }
+    int started = 0;
+    for (int i = 1; i < jobs; i++) {
+        if (pthread_create(&threads[started], NULL, extract_worker, &ctx) != 0) {
+            break;
+        }
+        started++;
+    }
+    extract_worker(&ctx);
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    close(out_dir);
+    fs_image_close(&img);
+
+    if (atomic_load(&ctx.failed) > 0) {
+        fprintf(stderr, "Error: %d file(s) could not be extracted\n", atomic_load(&ctx.failed));
+        return 1;
+    }
+
+    printf("Extracted %d file(s) successfully!\n", job_count);
+    return 0;
+}
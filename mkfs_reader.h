@@ -0,0 +1,259 @@
+// MiniVSFS on-disk layout and read-only image access, shared by mkfs_ls,
+// mkfs_extract and mkfs_defrag.
+// Helpers are static inline so any number of translation units may include it.
+#ifndef MKFS_READER_H
+#define MKFS_READER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#define BS 4096u
+#define INODE_SIZE 128u
+#define ROOT_INO 1u
+#define DIRECT_MAX 12
+#pragma pack(push, 1)
+
+typedef struct {
+    uint32_t magic;               // 0x4D565346
+    uint32_t version;             // 1
+    uint32_t block_size;          // 4096
+    uint64_t total_blocks;        // calculated from size_kib
+    uint64_t inode_count;         // from CLI
+    uint64_t inode_bitmap_start;  // 1
+    uint64_t inode_bitmap_blocks; // 1
+    uint64_t data_bitmap_start;   // 2
+    uint64_t data_bitmap_blocks;  // 1
+    uint64_t inode_table_start;   // 3
+    uint64_t inode_table_blocks;  // calculated
+    uint64_t data_region_start;   // calculated
+    uint64_t data_region_blocks;  // calculated
+    uint64_t root_inode;          // 1
+    uint64_t mtime_epoch;         // build time
+    uint32_t flags;               // 0
+    
+    // THIS FIELD SHOULD STAY AT THE END
+    // ALL OTHER FIELDS SHOULD BE ABOVE THIS
+    uint32_t checksum;            // crc32(superblock[0..4091])
+} superblock_t;
+#pragma pack(pop)
+_Static_assert(sizeof(superblock_t) == 116, "superblock must fit in one block");
+
+#pragma pack(push,1)
+typedef struct {
+    uint16_t mode;                // file/directory mode
+    uint16_t links;               // link count
+    uint32_t uid;                 // 0
+    uint32_t gid;                 // 0
+    uint64_t size_bytes;          // file size
+    uint64_t atime;               // access time
+    uint64_t mtime;               // modify time
+    uint64_t ctime;               // create time
+    uint32_t direct[12];          // direct block pointers
+    uint32_t reserved_0;          // 0
+    uint32_t reserved_1;          // 0
+    uint32_t reserved_2;          // 0
+    uint32_t proj_id;             // 3 (your group ID)
+    uint32_t uid16_gid16;         // 0
+    uint64_t xattr_ptr;           // 0
+
+    // THIS FIELD SHOULD STAY AT THE END
+    // ALL OTHER FIELDS SHOULD BE ABOVE THIS
+    uint64_t inode_crc;   // low 4 bytes store crc32 of bytes [0..119]; high 4 bytes 0
+
+} inode_t;
+#pragma pack(pop)
+_Static_assert(sizeof(inode_t)==INODE_SIZE, "inode size mismatch");
+
+#pragma pack(push,1)
+typedef struct {
+    uint32_t inode_no;            // inode number (0 if free)
+    uint8_t type;                 // 1=file, 2=dir
+    char name[58];                // filename/dirname
+
+    uint8_t  checksum; // XOR of bytes 0..62
+} dirent64_t;
+#pragma pack(pop)
+_Static_assert(sizeof(dirent64_t)==64, "dirent size mismatch");
+
+// ==================================READ API===================================
+// The image is mapped read-only and file contents are handed out as views into
+// the mapping. A file whose direct[] blocks are consecutive comes back as one
+// view; otherwise each run of consecutive blocks is its own iovec.
+
+typedef struct {
+    int fd;
+    uint8_t* base;                // start of the mapping (block 0)
+    size_t size;                  // mapped length in bytes
+    const superblock_t* sb;
+    const inode_t* inode_table;
+} fs_image_t;
+
+typedef struct {
+    struct iovec iov[DIRECT_MAX]; // runs of consecutive blocks, in file order
+    int iovcnt;                   // 1 means the file is contiguous
+    uint64_t size;                // file size in bytes
+} fs_view_t;
+
+// Nonzero when [start, start + blocks) lies below limit.
+static inline int fs_region_fits(uint64_t start, uint64_t blocks, uint64_t limit) {
+    return start <= limit && blocks <= limit - start;
+}
+
+// Nonzero when count items of per_block each fit in blocks blocks.
+static inline int fs_count_fits(uint64_t count, uint64_t blocks, uint64_t per_block) {
+    return count / per_block + (count % per_block != 0) <= blocks;
+}
+
+// Checks that every region lies inside the image in on-disk order and that
+// the bitmaps and inode table are large enough, without any sum or product
+// of superblock fields that could wrap.
+static inline int fs_layout_valid(const superblock_t* sb, uint64_t image_size) {
+    uint64_t image_blocks = image_size / BS;
+    return sb->inode_bitmap_start >= 1 && sb->data_bitmap_start >= 1 &&
+           fs_region_fits(sb->inode_bitmap_start, sb->inode_bitmap_blocks, sb->inode_table_start) &&
+           fs_region_fits(sb->data_bitmap_start, sb->data_bitmap_blocks, sb->inode_table_start) &&
+           fs_region_fits(sb->inode_table_start, sb->inode_table_blocks, sb->data_region_start) &&
+           fs_region_fits(sb->data_region_start, sb->data_region_blocks, image_blocks) &&
+           sb->inode_count >= ROOT_INO &&
+           fs_count_fits(sb->inode_count, sb->inode_table_blocks, BS / INODE_SIZE) &&
+           fs_count_fits(sb->inode_count, sb->inode_bitmap_blocks, BS * 8) &&
+           fs_count_fits(sb->data_region_blocks, sb->data_bitmap_blocks, BS * 8);
+}
+
+static inline int fs_image_open(const char* path, fs_image_t* img) {
+    memset(img, 0, sizeof(*img));
+    img->fd = open(path, O_RDONLY);
+    if (img->fd < 0) {
+        fprintf(stderr, "Error: Cannot open image %s\n", path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(img->fd, &st) != 0 || st.st_size < (off_t)BS) {
+        fprintf(stderr, "Error: Image %s is too small\n", path);
+        close(img->fd);
+        return -1;
+    }
+    img->size = st.st_size;
+
+    img->base = mmap(NULL, img->size, PROT_READ, MAP_SHARED, img->fd, 0);
+    if (img->base == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot map image %s\n", path);
+        close(img->fd);
+        return -1;
+    }
+
+    img->sb = (const superblock_t*)img->base;
+    if (img->sb->magic != 0x4D565346) {
+        fprintf(stderr, "Error: Invalid filesystem magic number\n");
+        munmap(img->base, img->size);
+        close(img->fd);
+        return -1;
+    }
+
+    if (!fs_layout_valid(img->sb, img->size)) {
+        fprintf(stderr, "Error: Superblock layout does not fit the image\n");
+        munmap(img->base, img->size);
+        close(img->fd);
+        return -1;
+    }
+
+    img->inode_table = (const inode_t*)(img->base + img->sb->inode_table_start * BS);
+    return 0;
+}
+
+static inline void fs_image_close(fs_image_t* img) {
+    munmap(img->base, img->size);
+    close(img->fd);
+}
+
+// Only meaningful once fs_layout_valid has accepted sb.
+static inline int fs_block_valid(const superblock_t* sb, uint32_t block) {
+    return block >= sb->data_region_start &&
+           block < sb->data_region_start + sb->data_region_blocks;
+}
+
+static inline const inode_t* fs_get_inode(const fs_image_t* img, uint32_t ino) {
+    if (ino < 1 || ino > img->sb->inode_count) {
+        return NULL;
+    }
+    const uint8_t* inode_bitmap = img->base + img->sb->inode_bitmap_start * BS;
+    if (!(inode_bitmap[(ino - 1) / 8] & (1 << ((ino - 1) % 8)))) {
+        return NULL;
+    }
+    return &img->inode_table[ino - 1];
+}
+
+// Fills view with the runs of consecutive data blocks backing ino.
+static inline int fs_file_view(const fs_image_t* img, const inode_t* ino, fs_view_t* view) {
+    memset(view, 0, sizeof(*view));
+    if (ino->size_bytes > (uint64_t)DIRECT_MAX * BS) {
+        return -1;
+    }
+    view->size = ino->size_bytes;
+
+    int blocks = (ino->size_bytes + BS - 1) / BS;
+    uint64_t remaining = ino->size_bytes;
+    for (int i = 0; i < blocks; i++) {
+        if (!fs_block_valid(img->sb, ino->direct[i])) {
+            return -1;
+        }
+        size_t len = remaining < BS ? remaining : BS;
+        remaining -= len;
+
+        if (i > 0 && ino->direct[i] == ino->direct[i - 1] + 1) {
+            view->iov[view->iovcnt - 1].iov_len += len;
+        } else {
+            view->iov[view->iovcnt].iov_base = img->base + (uint64_t)ino->direct[i] * BS;
+            view->iov[view->iovcnt].iov_len = len;
+            view->iovcnt++;
+        }
+    }
+    return 0;
+}
+
+// Walks the root directory; *cursor starts at 0. Returns 0 while entries remain.
+static inline int fs_next_dirent(const fs_image_t* img, int* cursor, const dirent64_t** out) {
+    const inode_t* root = &img->inode_table[ROOT_INO - 1];
+    int per_block = BS / sizeof(dirent64_t);
+    int blocks = (root->size_bytes + BS - 1) / BS;
+    if (blocks > DIRECT_MAX) {
+        blocks = DIRECT_MAX;
+    }
+
+    while (*cursor < blocks * per_block) {
+        int blk = *cursor / per_block;
+        int slot = *cursor % per_block;
+        (*cursor)++;
+        if (!fs_block_valid(img->sb, root->direct[blk])) {
+            continue;
+        }
+        const dirent64_t* de = (const dirent64_t*)(img->base + (uint64_t)root->direct[blk] * BS) + slot;
+        if (de->inode_no != 0) {
+            *out = de;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static inline int fs_lookup(const fs_image_t* img, const char* name) {
+    int cursor = 0;
+    const dirent64_t* de;
+    while (fs_next_dirent(img, &cursor, &de) == 0) {
+        if (strncmp(de->name, name, sizeof(de->name)) == 0) {
+            return de->inode_no;
+        }
+    }
+    return -1;
+}
+
+// ==================================READ API===================================
+
+#endif